@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    AudioBufferPool.cpp
+    Created: 19 Oct 2026 6:22:48pm
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "AudioBufferPool.h"
+
+void AudioBufferPool::prepare(int numBlocks, int newNumChannels, int samplesPerBlock)
+{
+    constexpr auto floatsPerAlignment = (int) (alignmentBytes / sizeof(float));
+
+    // Round each channel up so every channel, not just the first, starts on the alignment
+    const auto stride = (samplesPerBlock + floatsPerAlignment - 1) / floatsPerAlignment * floatsPerAlignment;
+
+    blocks.clear();
+    blockSize = samplesPerBlock;
+    numChannels = newNumChannels;
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        auto* block = blocks.add(new Block());
+        block->storage.calloc((size_t) (stride * numChannels + floatsPerAlignment));
+
+        auto* base = juce::snapPointerToAlignment(block->storage.get(), alignmentBytes);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            block->channels.push_back(base + ch * stride);
+
+        block->buffer.setDataToReferTo(block->channels.data(), numChannels, blockSize);
+    }
+}
+
+void AudioBufferPool::reset()
+{
+    blocks.clear();
+    blockSize = 0;
+    numChannels = 0;
+}
+
+int AudioBufferPool::acquire(int numSamples) noexcept
+{
+    jassert(numSamples <= blockSize);   // callers should split anything bigger
+
+    for (int i = 0; i < blocks.size(); ++i)
+    {
+        auto* block = blocks.getUnchecked(i);
+        bool expected = false;
+
+        if (block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            // Only swaps the channel pointers round, the storage is untouched
+            block->buffer.setDataToReferTo(block->channels.data(), numChannels, juce::jmin(numSamples, blockSize));
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void AudioBufferPool::release(int index) noexcept
+{
+    if (juce::isPositiveAndBelow(index, blocks.size()))
+        blocks.getUnchecked(index)->inUse.store(false, std::memory_order_release);
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    AudioBufferPool.h
+    Created: 19 Oct 2026 6:22:48pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Fixed set of preallocated, 64-byte aligned audio blocks that the audio thread
+// can borrow without touching the heap. Sized in prepareToPlay, then shared by
+// the record and waveform stages; a block stays checked out until the consumer
+// (e.g. the file writer thread) gives it back.
+class AudioBufferPool {
+public:
+    AudioBufferPool() {}
+
+    // Allocates; never call this while the audio callback is running.
+    void prepare(int numBlocks, int numChannels, int samplesPerBlock);
+    void reset();
+
+    // Lock-free. Returns a block index with its buffer resized to numSamples, or -1 if none are free.
+    int acquire(int numSamples) noexcept;
+    void release(int index) noexcept;
+
+    juce::AudioBuffer<float>& getBlock(int index) noexcept { return blocks.getUnchecked(index)->buffer; }
+    int getBlockSize() const noexcept { return blockSize; }
+    int getNumChannels() const noexcept { return numChannels; }
+
+private:
+    static constexpr size_t alignmentBytes = 64;
+
+    struct Block {
+        juce::HeapBlock<float> storage;
+        std::vector<float*> channels;
+        juce::AudioBuffer<float> buffer;
+        std::atomic<bool> inUse { false };
+    };
+
+    juce::OwnedArray<Block> blocks;
+    int blockSize = 0, numChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(AudioBufferPool)
+};
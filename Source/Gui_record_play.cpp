@@ -9,11 +9,24 @@
 */
 #include <JuceHeader.h>
 #include "gui_record_play.h"
+#include "PerfTrace.h"
 
 AppState state = IDLE;
 
+AudioToFileWriter::AudioToFileWriter(AudioBufferPool& pool)
+    : juce::Thread("File writer"), bufferPool(pool)
+{
+}
+
+AudioToFileWriter::~AudioToFileWriter()
+{
+    closeFile();
+}
+
 bool AudioToFileWriter::setup(const juce::File& outputFile, int sampleRate, int numChannels)
 {
+    closeFile();    // finish any take still open before its writer is replaced
+
     if (outputFile.existsAsFile())
     {
         outputFile.deleteFile();
@@ -27,6 +40,8 @@ bool AudioToFileWriter::setup(const juce::File& outputFile, int sampleRate, int
         // Instantiate WavAudioFormat
         juce::WavAudioFormat wavFormat;
 
+        std::lock_guard<std::mutex> lock(fileMutex);
+
         // Create the writer and let it take ownership of the stream
         writer.reset(wavFormat.createWriterFor(stream.release(),  // Transfer ownership
                                                sampleRate,
@@ -38,6 +53,10 @@ bool AudioToFileWriter::setup(const juce::File& outputFile, int sampleRate, int
         if (writer != nullptr)
         {
             DBG("File Write Successful");
+            samplesToSkip = 0;
+            drainQueue(false);  // nothing from an earlier take may reach this file
+            accepting = true;
+            startThread();
             return true;
         }
         else
@@ -54,34 +73,85 @@ bool AudioToFileWriter::setup(const juce::File& outputFile, int sampleRate, int
     return false;
 };
 
-void AudioToFileWriter::writeOutputToFile(const juce::AudioBuffer<float>& buffer)
+void AudioToFileWriter::setLatencyCompensation(int numSamples)
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    samplesToSkip = juce::jmax(0, numSamples);
+    DBG("Compensating recording by " << samplesToSkip << " samples");
+}
+
+bool AudioToFileWriter::queueBlock(int blockIndex) noexcept
 {
-    std::lock_guard<std::mutex> lock(fileMutex);  // Lock the mutex while writing
+    if (! accepting)
+        return false;
 
-    if (writer != nullptr)
+    const auto scope = queue.write(1);
+
+    if (scope.blockSize1 == 0)
+        return false;
+
+    queuedBlocks[(size_t) scope.startIndex1] = blockIndex;
+    return true;
+}
+
+void AudioToFileWriter::flush()
+{
+    PERF_TRACE_ZONE("AudioToFileWriter::flush");
+    std::lock_guard<std::mutex> lock(fileMutex);
+    drainQueue(true);
+}
+
+void AudioToFileWriter::drainQueue(bool writeBlocks)
+{
+    const auto scope = queue.read(queue.getNumReady());
+
+    scope.forEach([this, writeBlocks](int index)
     {
-        int numSamples = buffer.getNumSamples();
+        const auto blockIndex = queuedBlocks[(size_t) index];
 
-        if (numSamples > 0)
+        if (writeBlocks && writer != nullptr)
         {
-            writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+            const auto& block = bufferPool.getBlock(blockIndex);
+            const auto skipped = juce::jmin(samplesToSkip, block.getNumSamples());
+            samplesToSkip -= skipped;
+
+            if (block.getNumSamples() > skipped)
+                writer->writeFromAudioSampleBuffer(block, skipped, block.getNumSamples() - skipped);
         }
+
+        bufferPool.release(blockIndex);
+    });
+}
+
+void AudioToFileWriter::run()
+{
+    while (! threadShouldExit())
+    {
+        flush();
+        wait(5);
     }
-};
+}
 
 void AudioToFileWriter::closeFile()
 {
+    accepting = false;  // the audio thread stops handing us blocks from here on
+    stopThread(2000);
+    flush();    // whatever was queued after the thread's last pass
+
     std::lock_guard<std::mutex> lock(fileMutex);
 
     if (writer != nullptr)
     {
         DBG("Closing writer and associated file stream...");
+        samplesToSkip = 0;
         writer.reset();  // This will close the writer and the owned FileOutputStream
     }
     else
     {
         DBG("Writer was null, nothing to close.");
     }
+
+    drainQueue(false);  // a block that raced past `accepting` goes back to the pool unwritten
 }
 
 DisplayAudioWaveForm::DisplayAudioWaveForm()
@@ -111,6 +181,11 @@ void DisplayAudioWaveForm::paint(juce::Graphics &g){
     g.fillAll(juce::Colours::black);
 };
 
+void DisplayAudioWaveForm::TracedVisualiser::paint(juce::Graphics &g){
+    PERF_TRACE_ZONE("AudioVisualiserComponent::paint");
+    juce::AudioVisualiserComponent::paint(g);
+};
+
 void DisplayAudioWaveForm::resized(){
     auto bounds = getLocalBounds().reduced(10);
 
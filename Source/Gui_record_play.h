@@ -10,25 +10,47 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "AudioBufferPool.h"
 
 enum AppState {
     IDLE,
     PLAYING,
-    RECORDING
+    RECORDING,
+    MEASURING
 };
 
 extern AppState state;
 void changeState(AppState newState, juce::AudioTransportSource& transportSource, juce::TextButton& playButton, juce::TextButton& stopButton);
 
-class AudioToFileWriter {
+class AudioToFileWriter : private juce::Thread {
 public:
-    AudioToFileWriter(){}
+    explicit AudioToFileWriter(AudioBufferPool& pool);
+    ~AudioToFileWriter() override;
     bool setup(const juce::File& outputFile, int sampleRate, int numChannels);
-    void writeOutputToFile(const juce::AudioBuffer<float>& buffer);
+    // Drops this many samples from the start of the recording, to take out the
+    // device's round-trip latency. Call after setup().
+    void setLatencyCompensation(int numSamples);
+    // Audio thread: hands a block from the pool to the writer thread, which
+    // gives it back to the pool once it's on disk. False if the queue is full
+    // or no file is open, in which case the caller keeps the block.
+    bool queueBlock(int blockIndex) noexcept;
+    // Writes out anything still queued, on the calling thread.
+    void flush();
     void closeFile();
 private:
+    void run() override;
+    // Empties the queue and releases the blocks; fileMutex must be held.
+    void drainQueue(bool writeBlocks);
+
+    static constexpr int queueSize = 128;
+    AudioBufferPool& bufferPool;
+    juce::AbstractFifo queue { queueSize };
+    std::array<int, queueSize> queuedBlocks {};
+    std::atomic<bool> accepting { false };
+
     std::mutex fileMutex;
     std::unique_ptr<juce::AudioFormatWriter> writer;
+    int samplesToSkip = 0;
 };
 
 class DisplayAudioWaveForm : public juce::Component {
@@ -40,5 +62,13 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
 private:
-    juce::AudioVisualiserComponent audioVisualiser;
+    // The waveform is drawn by the visualiser on its own repaint timer, so its
+    // paint is where the GUI cost shows up in the trace.
+    class TracedVisualiser : public juce::AudioVisualiserComponent {
+    public:
+        using juce::AudioVisualiserComponent::AudioVisualiserComponent;
+        void paint(juce::Graphics& g) override;
+    };
+
+    TracedVisualiser audioVisualiser;
 };
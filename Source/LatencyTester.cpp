@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    LatencyTester.cpp
+    Created: 19 Oct 2026 8:14:36pm
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "LatencyTester.h"
+#include "PerfTrace.h"
+
+LatencyTester::LatencyTester()
+    : juce::Thread("Latency analysis")
+{
+}
+
+LatencyTester::~LatencyTester()
+{
+    stopThread(2000);
+}
+
+void LatencyTester::prepare(double sampleRate)
+{
+    running = false;
+
+    // White noise has a single sharp correlation peak; fade the edges to avoid clicks
+    testSignal.setSize(1, burstLength);
+    juce::Random random(0x5eed);
+    auto* signal = testSignal.getWritePointer(0);
+
+    for (int i = 0; i < burstLength; ++i)
+        signal[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.5f;
+
+    testSignal.applyGainRamp(0, 0, 64, 0.0f, 1.0f);
+    testSignal.applyGainRamp(0, burstLength - 64, 64, 1.0f, 0.0f);
+
+    captured.setSize(1, burstLength + (int) (sampleRate * maxLatencySeconds));
+    captured.clear();
+    position = 0;
+}
+
+void LatencyTester::start() noexcept
+{
+    running = false;
+    captured.clear();
+    position = 0;
+    running = true;
+}
+
+void LatencyTester::cancel()
+{
+    running = false;
+    stopThread(2000);
+    cancelPendingUpdate();
+}
+
+bool LatencyTester::isFinished() const noexcept
+{
+    return ! running && position.load() >= captured.getNumSamples() && captured.getNumSamples() > 0;
+}
+
+void LatencyTester::processBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    if (! running)
+    {
+        buffer.clear(startSample, numSamples);
+        return;
+    }
+
+    const auto pos = position.load();
+    const auto numToCapture = juce::jmin(numSamples, captured.getNumSamples() - pos);
+
+    // Take the input before the test signal overwrites it
+    if (buffer.getNumChannels() > 0 && numToCapture > 0)
+        captured.copyFrom(0, pos, buffer, 0, startSample, numToCapture);
+
+    buffer.clear(startSample, numSamples);
+
+    const auto numToPlay = juce::jlimit(0, numSamples, burstLength - pos);
+
+    for (int channel = 0; channel < buffer.getNumChannels() && numToPlay > 0; ++channel)
+        buffer.copyFrom(channel, startSample, testSignal, 0, pos, numToPlay);
+
+    position = pos + numToCapture;
+
+    if (position.load() >= captured.getNumSamples())
+        running = false;
+}
+
+void LatencyTester::analyse()
+{
+    stopThread(2000);
+    cancelPendingUpdate();
+
+    analysisSignal.makeCopyOf(testSignal);
+    analysisCapture.makeCopyOf(captured);
+    startThread();
+}
+
+void LatencyTester::run()
+{
+    result = findLatency();
+
+    if (! threadShouldExit())
+        triggerAsyncUpdate();
+}
+
+void LatencyTester::handleAsyncUpdate()
+{
+    if (onResult != nullptr)
+        onResult(result);
+}
+
+int LatencyTester::findLatency()
+{
+    PERF_TRACE_ZONE("LatencyTester::findLatency");
+
+    const auto* signal = analysisSignal.getReadPointer(0);
+    const auto* input = analysisCapture.getReadPointer(0);
+    const auto numLags = analysisCapture.getNumSamples() - burstLength;
+
+    double signalEnergy = 0.0, windowEnergy = 0.0;
+
+    for (int i = 0; i < burstLength; ++i)
+    {
+        signalEnergy += (double) signal[i] * signal[i];
+        windowEnergy += (double) input[i] * input[i];
+    }
+
+    int bestLag = -1;
+    double bestScore = 0.0;
+
+    for (int lag = 0; lag < numLags; ++lag)
+    {
+        if ((lag & 1023) == 0 && threadShouldExit())
+            return -1;
+
+        double correlation = 0.0;
+
+        for (int i = 0; i < burstLength; ++i)
+            correlation += (double) signal[i] * input[lag + i];
+
+        // Normalised so the level coming back through the loopback doesn't matter
+        const auto score = correlation / std::sqrt(signalEnergy * juce::jmax(windowEnergy, 1.0e-12));
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+
+        windowEnergy += (double) input[lag + burstLength] * input[lag + burstLength]
+                      - (double) input[lag] * input[lag];
+    }
+
+    DBG("Latency test: best correlation " << bestScore << " at " << bestLag << " samples");
+
+    return bestScore >= minCorrelation ? bestLag : -1;
+}
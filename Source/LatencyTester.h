@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    LatencyTester.h
+    Created: 19 Oct 2026 8:14:36pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Measures the device's round-trip latency through a loopback (output patched
+// or held up to the input): a short noise burst is played while the input is
+// captured, and the capture is cross-correlated against the burst to find
+// how many samples later it came back. The search runs on its own thread and
+// the result is handed back on the message thread through onResult.
+class LatencyTester : private juce::Thread,
+                      private juce::AsyncUpdater {
+public:
+    LatencyTester();
+    ~LatencyTester() override;
+
+    // Builds the test signal and the capture buffer; allocates, so call from prepareToPlay.
+    void prepare(double sampleRate);
+
+    void start() noexcept;
+    // Also abandons an analysis in progress, its result is never delivered.
+    void cancel();
+    bool isFinished() const noexcept;
+    bool isRunning() const noexcept { return running; }
+
+    // Audio thread: captures input channel 0, then replaces every channel with the test signal.
+    void processBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    // Once finished: copies the capture and searches it in the background, a full
+    // correlation is far too slow for the message thread at high sample rates.
+    void analyse();
+
+    // Round-trip latency in samples, or -1 if the burst wasn't heard clearly.
+    std::function<void(int)> onResult;
+
+private:
+    void run() override;
+    void handleAsyncUpdate() override;
+    int findLatency();
+    static constexpr int burstLength = 2048;
+    static constexpr double maxLatencySeconds = 0.5;
+    static constexpr double minCorrelation = 0.3;
+
+    juce::AudioBuffer<float> testSignal, captured;
+    std::atomic<int> position { 0 };
+    std::atomic<bool> running { false };
+
+    // Copies for the analysis thread, prepare() may rebuild the originals meanwhile
+    juce::AudioBuffer<float> analysisSignal, analysisCapture;
+    std::atomic<int> result { -1 };
+
+    JUCE_DECLARE_NON_COPYABLE(LatencyTester)
+};
@@ -8,6 +8,7 @@
 
 #include <JuceHeader.h>
 #include "MainContentComponent.h"
+#include "PerfTrace.h"
 
 //==============================================================================
 class AudioPlayerandRecorderApplication  : public juce::JUCEApplication
@@ -24,8 +25,16 @@ public:
     void initialise (const juce::String& commandLine) override
     {
         // This method is where you should put your application's initialisation code..
+        auto& trace = PerfTrace::getInstance();   // starts the startup clock
+
+        if (commandLine.contains ("--trace"))
+            trace.setEnabled (true);
+
+        trace.markStartupPhase ("initialise");
 
         mainWindow.reset (new MainWindow (getApplicationName()));
+
+        trace.markStartupPhase ("window created");   // "window visible" is marked on the first paint
     }
 
     void shutdown() override
@@ -1,14 +1,18 @@
 #include <JuceHeader.h>
 #include "MainContentComponent.h"
 #include "gui_record_play.h"
+#include "PerfTrace.h"
+#include "RealtimeAllocationCheck.h"
 
 MainContentComponent::MainContentComponent()
 {
-    addAndMakeVisible(displayAudioWaveForm);
-    
+    PERF_TRACE_ZONE("MainContentComponent::MainContentComponent");
+
+    // Everything stays disabled until the formats are registered and the device is open
     addAndMakeVisible(&openButton);
     openButton.setButtonText("Open...");
     openButton.addListener(this);
+    openButton.setEnabled(false);
 
 
     addAndMakeVisible(&playButton);
@@ -27,28 +31,137 @@ MainContentComponent::MainContentComponent()
     recordButton.setButtonText("Record");
     recordButton.addListener(this);
     recordButton.setColour(juce::TextButton::buttonColourId, juce::Colours::red);
-//    recordButton.setEnabled()
+    recordButton.setEnabled(false);
     
+    addAndMakeVisible(&hqResampleButton);
+    hqResampleButton.setButtonText("High quality resampling");
+    hqResampleButton.addListener(this);
+    hqResampleButton.setEnabled(false);
+
+    addAndMakeVisible(&monitorButton);
+    monitorButton.setButtonText("Monitor input");
+    monitorButton.addListener(this);
+    monitorButton.setEnabled(false);
+
+    addAndMakeVisible(&bufferSizeBox);
+    bufferSizeBox.setTextWhenNothingSelected("Buffer size");
+    bufferSizeBox.addListener(this);
+    bufferSizeBox.setEnabled(false);
+
+    addAndMakeVisible(&measureLatencyButton);
+    measureLatencyButton.setButtonText("Measure latency (loopback)");
+    measureLatencyButton.addListener(this);
+    measureLatencyButton.setEnabled(false);
+
+    addAndMakeVisible(&latencyLabel);
+
     addAndMakeVisible(scrubber);
     scrubber.setEnabled(false);
     scrubber.setRange(0.0, 1.0);
     scrubber.addListener(this);
 
     setSize(600, 400);
+    setWantsKeyboardFocus(true);
 
-    formatManager.registerBasicFormats();       // [1]
-    transportSource.addChangeListener(this);    // [2]
+    transportSource.addChangeListener(this);
 
-    setAudioChannels(1, 2);
+    latencyTester.onResult = [this](int latency)
+    {
+        finishLatencyMeasurement(latency);
+    };
+
+    // The device is opened from the first paint(), once the window is on screen
+    startupThread.startThread();
 }
 
 MainContentComponent::~MainContentComponent()
 {
+    startupThread.stopThread(10000);    // format registration can't be interrupted, let it finish
     transportSource.stop();
     transportSource.setSource(nullptr);
     shutdownAudio();
 }
 
+MainContentComponent::StartupThread::StartupThread(MainContentComponent& ownerToNotify)
+    : juce::Thread("Startup"), owner(ownerToNotify)
+{
+}
+
+void MainContentComponent::StartupThread::run()
+{
+    {
+        PERF_TRACE_ZONE("registerBasicFormats");
+        owner.formatManager.registerBasicFormats();
+    }
+    PerfTrace::getInstance().markStartupPhase("formats registered");
+
+    juce::MessageManager::callAsync([safeOwner = juce::Component::SafePointer<MainContentComponent>(&owner)]
+    {
+        if (safeOwner != nullptr)
+            safeOwner->startupStepFinished();
+    });
+}
+
+void MainContentComponent::openAudioDevice()
+{
+    PERF_TRACE_ZONE("openAudioDevice");
+
+    // Has to exist before the audio callback starts
+    displayAudioWaveForm = std::make_unique<DisplayAudioWaveForm>();
+    addAndMakeVisible(*displayAudioWaveForm);
+    resized();
+
+    // Device types expect to be opened from the message thread (COM on Windows,
+    // audio sessions on mobile), so this stays here rather than on StartupThread.
+    // It also copes with devices that can't give us 1 in / 2 out.
+    setAudioChannels(1, 2);
+
+    PerfTrace::getInstance().markStartupPhase("audio device open");
+    startupStepFinished();
+}
+
+SegmentedDecoder& MainContentComponent::getSegmentedDecoder()
+{
+    if (segmentedDecoder == nullptr)
+        segmentedDecoder = std::make_unique<SegmentedDecoder>(formatManager);
+
+    return *segmentedDecoder;
+}
+
+ResampledCache& MainContentComponent::getResampledCache()
+{
+    if (resampledCache == nullptr)
+    {
+        resampledCache = std::make_unique<ResampledCache>(formatManager);
+        resampledCache->onReady = [this](std::unique_ptr<juce::AudioFormatReader> reader)
+        {
+            useCachedSource(std::move(reader));
+        };
+    }
+
+    return *resampledCache;
+}
+
+void MainContentComponent::startupStepFinished()
+{
+    // Formats and device finish in either order; only the second one enables the UI
+    if (++startupStepsDone < 2)
+        return;
+
+    openButton.setEnabled(true);
+    recordButton.setEnabled(true);
+    hqResampleButton.setEnabled(true);
+    monitorButton.setEnabled(true);
+    measureLatencyButton.setEnabled(true);
+    updateBufferSizes();
+
+    // Nothing has focus until a control is clicked, and keyPressed only sees keys
+    // that reach a focused component, so take it here for the tracing shortcut
+    grabKeyboardFocus();
+
+    PerfTrace::getInstance().markStartupPhase("ready");
+}
+
 void MainContentComponent::changeState(AppState newState)
 {
     if (state != newState)
@@ -74,12 +187,32 @@ void MainContentComponent::changeState(AppState newState)
         }
         else if (state == RECORDING)
         {
-            transportSource.stop();             // Ensure transport is stopped
-            transportSource.setSource(nullptr); // Clear the source
+            transportSource.setPosition(0.0);   // The loaded file plays from the top as the overdub reference
+            transportSource.start();
             stopButton.setEnabled(true);
             playButton.setEnabled(false);
             scrubber.setEnabled(false);
         }
+        else if (state == MEASURING)
+        {
+            transportSource.stop();             // The test signal needs the outputs to itself
+            stopButton.setEnabled(true);
+            playButton.setEnabled(false);
+            scrubber.setEnabled(false);
+            startTimerHz(30);                   // polls for the end of the measurement
+        }
+
+        // Measuring takes over the outputs, so only offer it when nothing else is going on
+        measureLatencyButton.setEnabled(state == IDLE);
+
+        // A take or a measurement needs the device and the loaded file left alone: a new
+        // file would change the overdub reference, a second record would replace the open
+        // writer, and a buffer size change restarts the device (a gap in the take, or a
+        // reset tester)
+        const auto busy = state == RECORDING || state == MEASURING;
+        openButton.setEnabled(! busy);
+        recordButton.setEnabled(! busy);
+        bufferSizeBox.setEnabled(! busy && bufferSizeBox.getNumItems() > 0);
     }
 }
 
@@ -103,7 +236,11 @@ void MainContentComponent::buttonClicked(juce::Button* button){
     }
     else if (button == &stopButton){
         if(state == RECORDING){
+            changeState(IDLE);          // stop the audio thread queuing blocks first
             fileWriter.closeFile();
+        }
+        else if (state == MEASURING){
+            latencyTester.cancel();
             changeState(IDLE);
         }
         else if (transportSource.isPlaying()) {
@@ -118,15 +255,54 @@ void MainContentComponent::buttonClicked(juce::Button* button){
         openFile(true);
 //        changeState(RECORDING);
     }
+    else if (button == &monitorButton){
+        monitoringEnabled = monitorButton.getToggleState();
+    }
+    else if (button == &measureLatencyButton){
+        if (state != IDLE)
+            return;
+
+        DBG("Measuring round-trip latency, connect the output to the input...");
+        latencyTester.start();
+        changeState(MEASURING);
+    }
+    else if (button == &hqResampleButton){
+        if (hqResampleButton.getToggleState()){
+            startResampledRender();
+        }
+        else {
+            if (usingCachedSource)
+                useRealtimeSource();
+            if (resampledCache != nullptr)
+                resampledCache->invalidate();
+        }
+    }
 }
 
 void MainContentComponent::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    // All the memory the audio thread will need is taken here, before the callback starts
+    fileWriter.flush();     // nothing may still be holding a block when the pool is rebuilt
+    bufferPool.prepare(numPoolBlocks, numRecordChannels, samplesPerBlockExpected);
+    latencyTester.prepare(sampleRate);
+    monitorBuffer.setSize(numRecordChannels, samplesPerBlockExpected);
+    RealtimeAllocationCheck::setPrepared(true);
+
+    // The cache is only valid for one device rate, so let the message thread re-check it
+    juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<MainContentComponent>(this), sampleRate]
+    {
+        if (safeThis != nullptr)
+            safeThis->deviceSampleRateChanged(sampleRate);
+    });
 }
 
 void MainContentComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
+    PERF_TRACE_ZONE("getNextAudioBlock");
+    const RealtimeAllocationCheck::ScopedAudioCallback realtimeCheck;
+
     if (state == IDLE)
     {
         bufferToFill.clearActiveBufferRegion();
@@ -139,34 +315,106 @@ void MainContentComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo&
 //        NEW
         return;
     }
+    else if (state == MEASURING)
+    {
+        latencyTester.processBlock(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+        return;
+    }
     else if (state == RECORDING)
     {
         // Capture input audio when recording
         auto* device = deviceManager.getCurrentAudioDevice();
+        int maxInputChannels = 0;
+
         if (device != nullptr)
         {
             auto activeInputChannels = device->getActiveInputChannels();
-            const int maxInputChannels = activeInputChannels.getHighestBit() + 1;
+            maxInputChannels = activeInputChannels.getHighestBit() + 1;
 
-            for (int channel = 0; channel < maxInputChannels; ++channel)
+            if (maxInputChannels > 0 && bufferPool.getBlockSize() > 0)
             {
-                if (auto* inputChannelData = bufferToFill.buffer->getWritePointer(channel))
+                // Copy the input into pooled blocks, splitting it if the device
+                // sends more than it said it would in prepareToPlay
+                for (int offset = 0; offset < bufferToFill.numSamples; offset += bufferPool.getBlockSize())
                 {
+                    const int numSamples = juce::jmin(bufferPool.getBlockSize(), bufferToFill.numSamples - offset);
+                    const int blockIndex = bufferPool.acquire(numSamples);
+
+                    if (blockIndex < 0)
+                        break;  // writer has fallen behind, drop rather than allocate
+
+                    auto& block = bufferPool.getBlock(blockIndex);
+
+                    for (int channel = 0; channel < block.getNumChannels(); ++channel)
+                        block.copyFrom(channel, 0, *bufferToFill.buffer, juce::jmin(channel, maxInputChannels - 1),
+                                       bufferToFill.startSample + offset, numSamples);
+
                     // Add the input channel data to the waveform display
-                    displayAudioWaveForm.addAudioData(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+                    displayAudioWaveForm->addAudioData(block, 0, numSamples);
 
-                    // Write the input audio to file
-                    fileWriter.writeOutputToFile(*bufferToFill.buffer);
-                    return;
+                    // The writer thread puts the block on disk and hands it back to the pool
+                    if (! fileWriter.queueBlock(blockIndex))
+                        bufferPool.release(blockIndex);
                 }
             }
         }
+
+        // Play the loaded file to overdub against, with the input mixed over it when
+        // monitoring. The input is set aside first, in chunks that fit monitorBuffer.
+        const auto monitor = monitoringEnabled && maxInputChannels > 0;
+        const auto chunkSize = monitorBuffer.getNumSamples();
+
+        if (chunkSize == 0)
+        {
+            bufferToFill.clearActiveBufferRegion();
+            return;
+        }
+
+        for (int offset = 0; offset < bufferToFill.numSamples; offset += chunkSize)
+        {
+            const int numSamples = juce::jmin(chunkSize, bufferToFill.numSamples - offset);
+            const int start = bufferToFill.startSample + offset;
+
+            if (monitor)
+                monitorBuffer.copyFrom(0, 0, *bufferToFill.buffer, 0, start, numSamples);
+
+            transportSource.getNextAudioBlock(juce::AudioSourceChannelInfo(bufferToFill.buffer, start, numSamples));
+
+            if (monitor)
+                for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+                    bufferToFill.buffer->addFrom(channel, start, monitorBuffer, 0, 0, numSamples);
+        }
     }
 };
 
 void MainContentComponent::releaseResources()
 {
     transportSource.releaseResources();
+
+    RealtimeAllocationCheck::setPrepared(false);
+    jassert(RealtimeAllocationCheck::getNumViolations() == 0);    // the audio thread allocated, see the first assertion
+
+    fileWriter.flush();
+    bufferPool.reset();
+}
+
+void MainContentComponent::paint(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    // Opening the device can block for a while on some drivers, so wait until the
+    // window has really drawn; the short delay lets this frame reach the screen first
+    if (! deviceOpenScheduled)
+    {
+        deviceOpenScheduled = true;
+        PerfTrace::getInstance().markStartupPhase("window visible");
+
+        juce::Timer::callAfterDelay(20, [safeThis = juce::Component::SafePointer<MainContentComponent>(this)]
+        {
+            if (safeThis != nullptr)
+                safeThis->openAudioDevice();
+        });
+    }
 }
 
 void MainContentComponent::resized()
@@ -175,10 +423,16 @@ void MainContentComponent::resized()
     playButton.setBounds(10, 40, getWidth() - 20, 20);
     stopButton.setBounds(10, 70, getWidth() - 20, 20);
     recordButton.setBounds(10, 100, getWidth() - 20, 20);
+    hqResampleButton.setBounds(10, 130, getWidth() - 20, 20);
+    monitorButton.setBounds(10, 160, getWidth() / 2 - 15, 20);
+    bufferSizeBox.setBounds(getWidth() / 2 + 5, 160, getWidth() / 2 - 15, 20);
+    measureLatencyButton.setBounds(10, 190, getWidth() / 2 - 15, 20);
+    latencyLabel.setBounds(getWidth() / 2 + 5, 190, getWidth() / 2 - 15, 20);
     
-    scrubber.setBounds(10, 130, getWidth() - 20, 20);
+    scrubber.setBounds(10, 220, getWidth() - 20, 20);
     
-    displayAudioWaveForm.setBounds(10, 160, getWidth() - 20, getHeight() - 160);
+    if (displayAudioWaveForm != nullptr)
+        displayAudioWaveForm->setBounds(10, 250, getWidth() - 20, getHeight() - 250);
 
 }
 
@@ -186,6 +440,10 @@ void MainContentComponent::changeListenerCallback(juce::ChangeBroadcaster* sourc
 {
     if (source == &transportSource)
     {
+        // Recording and measuring drive the transport themselves; its messages mustn't end them
+        if (state == RECORDING || state == MEASURING)
+            return;
+
         if (transportSource.isPlaying())
             state = PLAYING;
         else
@@ -194,10 +452,75 @@ void MainContentComponent::changeListenerCallback(juce::ChangeBroadcaster* sourc
 }
 
 void MainContentComponent::timerCallback(){
+    PERF_TRACE_ZONE("timerCallback");
     if (state == PLAYING){
         scrubber.setValue(transportSource.getCurrentPosition(), juce::dontSendNotification);
     }
+    else if (state == MEASURING){
+        if (latencyTester.isFinished()){
+            stopTimer();    // the search reports back through onResult
+            latencyLabel.setText("Latency: analysing...", juce::dontSendNotification);
+            latencyTester.analyse();
+        }
+        else if (! latencyTester.isRunning()){
+            // prepareToPlay re-prepared the tester (the device restarted), the run is lost
+            latencyLabel.setText("Latency: measurement interrupted", juce::dontSendNotification);
+            changeState(IDLE);
+        }
+    }
+}
+
+void MainContentComponent::comboBoxChanged(juce::ComboBox* comboBox){
+    if (comboBox == &bufferSizeBox && bufferSizeBox.getSelectedId() > 0){
+        if (state == MEASURING){
+            latencyTester.cancel();     // the restart below would reset it anyway
+            changeState(IDLE);
+        }
+
+        // Smaller buffers mean lower monitoring latency, at the cost of more CPU headroom
+        auto setup = deviceManager.getAudioDeviceSetup();
+        setup.bufferSize = bufferSizeBox.getSelectedId();
+
+        auto error = deviceManager.setAudioDeviceSetup(setup, true);
+        if (error.isNotEmpty())
+            DBG("Failed to change buffer size: " << error);
+
+        resetLatencyMeasurement();  // the old figure was for the old buffer size
+    }
+}
+bool MainContentComponent::keyPressed(const juce::KeyPress& key)
+{
+    // Cmd/Ctrl+T starts tracing, pressing it again writes the trace to the desktop
+    if (key == juce::KeyPress('t', juce::ModifierKeys::commandModifier, 0))
+    {
+        toggleTracing();
+        return true;
+    }
+    return false;
+}
+
+void MainContentComponent::toggleTracing()
+{
+    auto& trace = PerfTrace::getInstance();
+
+    if (! trace.isEnabled())
+    {
+        trace.setEnabled(true);
+        DBG("Tracing started");
+        return;
+    }
+
+    trace.setEnabled(false);
+
+    auto traceFile = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                         .getNonexistentChildFile("AudioPlayerTrace", ".json");
+
+    if (trace.exportChromeTrace(traceFile))
+        DBG("Trace written to " << traceFile.getFullPathName());
+    else
+        DBG("Failed to write trace file.");
 }
+
 void MainContentComponent::sliderValueChanged(juce::Slider* slider){
     if (slider == &scrubber && (state == PLAYING || state == IDLE)){
         transportSource.setPosition(scrubber.getValue());
@@ -207,9 +530,9 @@ void MainContentComponent::sliderValueChanged(juce::Slider* slider){
 void MainContentComponent::openFile(bool forOutput)
 {
     chooser = std::make_unique<juce::FileChooser>(
-        forOutput ? "Select a file to save recording..." : "Select a Wave file to play...",
+        forOutput ? "Select a file to save recording..." : "Select an audio file to play...",
         juce::File{},
-        "*.wav");
+        forOutput ? juce::String("*.wav") : formatManager.getWildcardForAllFormats());
 
     int chooserFlags = forOutput
         ? juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
@@ -225,14 +548,15 @@ void MainContentComponent::openFile(bool forOutput)
 
             if (!filePath.isEmpty())
             {
-                // Stop the transport source before changing its source
-                transportSource.stop();
-                transportSource.setSource(nullptr);
-
+                // The loaded file stays attached for recording, it's the overdub reference
                 if (forOutput)  // Recording mode
                 {
-                    if (fileWriter.setup(file, 44100, 1))  // Adjust sample rate and channels as needed
+                    auto* device = deviceManager.getCurrentAudioDevice();
+                    const int sampleRate = device != nullptr ? (int) device->getCurrentSampleRate() : 44100;
+
+                    if (fileWriter.setup(file, sampleRate, numRecordChannels))
                     {
+                        fileWriter.setLatencyCompensation(getRecordOffset());
                         DBG("Recording to file: " << filePath);
                         changeState(RECORDING);  // Start recording after successful setup
                     }
@@ -268,6 +592,8 @@ void MainContentComponent::openFile(bool forOutput)
 
 bool MainContentComponent::loadAudioFile(const juce::File &file)
 {
+    PERF_TRACE_ZONE("loadAudioFile");
+
     // Stop the transport source before changing its source
     transportSource.stop();
     transportSource.setSource(nullptr);
@@ -281,19 +607,161 @@ bool MainContentComponent::loadAudioFile(const juce::File &file)
         readerSource.reset(new juce::AudioFormatReaderSource(reader, true));
         transportSource.setSource(readerSource.get(), 0, nullptr, reader->sampleRate);
 
+        // Play with real-time conversion until a resampled cache is ready (if enabled)
+        currentFile = file;
+        fileSampleRate = reader->sampleRate;
+        usingCachedSource = false;
+        startResampledRender();
+
         // Set scrubber range and enable
         scrubber.setRange(0.0, transportSource.getLengthInSeconds());
         scrubber.setEnabled(true);
 
-        // Load the file data into the waveform display
-        juce::AudioBuffer<float> buffer((int)reader->numChannels, (int)reader->lengthInSamples);
-        reader->read(&buffer, 0, (int)reader->lengthInSamples, 0, true, true);
+        // Decode the whole file across the worker pool for the waveform display
+        SegmentedDecoder::Result analysis;
+
+        if (! getSegmentedDecoder().decode(file, analysis))
+        {
+            DBG("Failed to decode file for analysis.");
+            return true;  // Playback still works, only the overview is missing
+        }
+
+        DBG("Analysis: peak " << analysis.peak << ", rms " << analysis.rms
+            << " over " << analysis.segmentPeaks.size() << " segments");
 
         // Push the buffer data to the waveform visualizer
-        displayAudioWaveForm.addAudioData(buffer, 0, (int)reader->lengthInSamples);
+        displayAudioWaveForm->addAudioData(analysis.samples, 0, analysis.samples.getNumSamples());
 
         return true;  // Successfully loaded the file into the visualizer
     }
 
     return false;  // Failed to load the file
 };
+
+void MainContentComponent::deviceSampleRateChanged(double newSampleRate)
+{
+    if (newSampleRate == deviceSampleRate)
+        return;
+
+    deviceSampleRate = newSampleRate;
+    resetLatencyMeasurement();
+
+    if (usingCachedSource)
+        useRealtimeSource();
+
+    startResampledRender();
+}
+
+void MainContentComponent::startResampledRender()
+{
+    if (resampledCache != nullptr)
+        resampledCache->invalidate();
+
+    if (! hqResampleButton.getToggleState() || currentFile == juce::File{} || deviceSampleRate <= 0.0)
+        return;
+
+    if (fileSampleRate == deviceSampleRate)
+        return;  // nothing to convert
+
+    DBG("Rendering " << currentFile.getFileName() << " at " << deviceSampleRate << " Hz in the background");
+    getResampledCache().render(currentFile, deviceSampleRate);
+}
+
+void MainContentComponent::useRealtimeSource()
+{
+    if (auto* reader = formatManager.createReaderFor(currentFile))
+    {
+        swapReaderSource(reader, reader->sampleRate);
+        usingCachedSource = false;
+    }
+}
+
+void MainContentComponent::useCachedSource(std::unique_ptr<juce::AudioFormatReader> reader)
+{
+    // Don't move the overdub reference under a take that's lined up against it
+    if (state == RECORDING || reader == nullptr)
+        return;
+
+    // Already at the device rate (and invalidated when that changes), so no rate is
+    // passed: any non-zero one would put a ResamplingAudioSource back in the chain
+    swapReaderSource(reader.release(), 0.0);
+    usingCachedSource = true;
+}
+
+void MainContentComponent::swapReaderSource(juce::AudioFormatReader* reader, double sourceSampleRateToCorrectFor)
+{
+    auto newSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+    auto oldSource = std::move(readerSource);
+
+    {
+        // setSource() leaves the transport stopped, so hold the audio callback off until
+        // it's playing again: the callback sees the old source or the new one, never a
+        // gap, and there's no stop() to wait on
+        const juce::ScopedLock sl(deviceManager.getAudioCallbackLock());
+        const auto position = transportSource.getCurrentPosition();
+        const auto wasPlaying = transportSource.isPlaying();
+
+        transportSource.setSource(newSource.get(), 0, nullptr, sourceSampleRateToCorrectFor);
+        transportSource.setPosition(position);
+
+        if (wasPlaying)
+            transportSource.start();
+    }
+
+    readerSource = std::move(newSource);
+}   // the old source (and its file) is closed here, outside the lock
+
+void MainContentComponent::updateBufferSizes()
+{
+    bufferSizeBox.clear(juce::dontSendNotification);
+
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+    {
+        for (auto size : device->getAvailableBufferSizes())
+            bufferSizeBox.addItem(juce::String(size) + " samples", size);
+
+        bufferSizeBox.setSelectedId(device->getCurrentBufferSizeSamples(), juce::dontSendNotification);
+        bufferSizeBox.setEnabled(true);
+    }
+
+    resetLatencyMeasurement();
+}
+
+void MainContentComponent::finishLatencyMeasurement(int latency)
+{
+    if (state != MEASURING)
+        return;
+
+    if (latency >= 0)
+    {
+        measuredLatency = latency;
+        const auto ms = deviceSampleRate > 0.0 ? 1000.0 * latency / deviceSampleRate : 0.0;
+        latencyLabel.setText("Latency: " + juce::String(latency) + " samples (" + juce::String(ms, 1) + " ms)",
+                             juce::dontSendNotification);
+    }
+    else
+    {
+        latencyLabel.setText("Latency: test signal not heard", juce::dontSendNotification);
+    }
+
+    changeState(IDLE);
+}
+
+void MainContentComponent::resetLatencyMeasurement()
+{
+    measuredLatency = -1;
+    latencyLabel.setText("Latency: " + juce::String(getRecordOffset()) + " samples (reported)",
+                         juce::dontSendNotification);
+}
+
+int MainContentComponent::getRecordOffset()
+{
+    if (measuredLatency >= 0)
+        return measuredLatency;
+
+    // Fall back on what the driver claims until a loopback measurement has been made
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        return device->getInputLatencyInSamples() + device->getOutputLatencyInSamples();
+
+    return 0;
+}
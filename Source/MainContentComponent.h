@@ -2,12 +2,16 @@
 
 #include <JuceHeader.h>
 #include "gui_record_play.h"
+#include "SegmentedDecoder.h"
+#include "ResampledCache.h"
+#include "LatencyTester.h"
 
 
 class MainContentComponent   : public juce::AudioAppComponent,
                                public juce::ChangeListener,
                                public juce::Button::Listener,
                                public juce::Slider::Listener,
+                               public juce::ComboBox::Listener,
                                public juce::Timer
 
 {
@@ -18,29 +22,82 @@ public:
     void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
     void releaseResources() override;
+    void paint(juce::Graphics& g) override;
     void resized() override;
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
     void buttonClicked(juce::Button* button) override;
     void sliderValueChanged(juce::Slider* slider) override;
+    void comboBoxChanged(juce::ComboBox* comboBox) override;
     void timerCallback() override;
+    bool keyPressed(const juce::KeyPress& key) override;
 
 private:
-    AudioToFileWriter fileWriter;
+    // Registers the formats off the message thread while the window comes up.
+    class StartupThread : public juce::Thread {
+    public:
+        explicit StartupThread(MainContentComponent& owner);
+        void run() override;
+    private:
+        MainContentComponent& owner;
+    };
+
+    static constexpr int numPoolBlocks = 64;
+    static constexpr int numRecordChannels = 1;     // matches setAudioChannels(1, 2)
+
+    AudioBufferPool bufferPool;
+    AudioToFileWriter fileWriter { bufferPool };
+    juce::AudioBuffer<float> monitorBuffer;     // the input, set aside while the transport overwrites it
     
     void openFile(bool forOutput);
     bool loadAudioFile(const juce::File &file);
     void changeState(AppState newState);
+    void toggleTracing();
+    void openAudioDevice();
+    void startupStepFinished();
+
+    // Built on first use, the decoder's pool alone is a thread per core
+    SegmentedDecoder& getSegmentedDecoder();
+    ResampledCache& getResampledCache();
+
+    void deviceSampleRateChanged(double newSampleRate);
+    void startResampledRender();
+    void useRealtimeSource();
+    void useCachedSource(std::unique_ptr<juce::AudioFormatReader> reader);
+    void swapReaderSource(juce::AudioFormatReader* reader, double sourceSampleRateToCorrectFor);
+
+    void updateBufferSizes();
+    void finishLatencyMeasurement(int latency);
+    void resetLatencyMeasurement();
+    int getRecordOffset();
     
-    DisplayAudioWaveForm displayAudioWaveForm;
+    std::unique_ptr<DisplayAudioWaveForm> displayAudioWaveForm;     // created once startup has finished
     juce::TextButton openButton, playButton, stopButton, recordButton;
+    juce::ToggleButton hqResampleButton, monitorButton;
+    juce::ComboBox bufferSizeBox;
+    juce::TextButton measureLatencyButton;
+    juce::Label latencyLabel;
     juce::Slider scrubber;
 
     std::unique_ptr<juce::FileChooser> chooser;
 
     juce::AudioFormatManager formatManager;
+    std::unique_ptr<SegmentedDecoder> segmentedDecoder;
     std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
     juce::AudioTransportSource transportSource;
 
+    std::unique_ptr<ResampledCache> resampledCache;
+    juce::File currentFile;
+    double fileSampleRate = 0.0, deviceSampleRate = 0.0;
+    bool usingCachedSource = false;
+
+    LatencyTester latencyTester;
+    int measuredLatency = -1;                   // round trip in samples, -1 until measured
+    std::atomic<bool> monitoringEnabled { false };
+
+    StartupThread startupThread { *this };
+    int startupStepsDone = 0;
+    bool deviceOpenScheduled = false;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainContentComponent)
 };
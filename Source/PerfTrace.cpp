@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    PerfTrace.cpp
+    Created: 19 Oct 2026 10:12:04am
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "PerfTrace.h"
+#include "RealtimeAllocationCheck.h"
+
+PerfTrace& PerfTrace::getInstance()
+{
+    static PerfTrace instance;
+    return instance;
+}
+
+PerfTrace::PerfTrace()
+    : originTicks(juce::Time::getHighResolutionTicks())
+{
+}
+
+PerfTrace::ThreadBuffer::ThreadBuffer(juce::String threadName, juce::int64 threadId)
+    : name(std::move(threadName)), tid(threadId), events((size_t) capacity)
+{
+}
+
+void PerfTrace::ThreadBuffer::push(const Event& e) noexcept
+{
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        events[(size_t) scope.startIndex1] = e;
+    else
+        dropped.fetch_add(1, std::memory_order_relaxed);  // exporter hasn't drained us, lose the event rather than block
+}
+
+void PerfTrace::setEnabled(bool shouldBeEnabled)
+{
+    enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+
+PerfTrace::ThreadBuffer& PerfTrace::getBufferForThisThread()
+{
+    struct Registration {
+        ~Registration()
+        {
+            if (buffer != nullptr)
+                buffer->inUse.store(false, std::memory_order_release);
+        }
+
+        ThreadBuffer* buffer = nullptr;
+    };
+
+    thread_local Registration registration;
+
+    if (registration.buffer == nullptr)
+    {
+        // Registration allocates, but only once per thread and only while tracing is on.
+        const RealtimeAllocationCheck::ScopedAllocationAllowed allowed;
+        const auto tid = (juce::int64) (juce::pointer_sized_int) juce::Thread::getCurrentThreadId();
+        juce::String threadName;
+
+        if (auto* thread = juce::Thread::getCurrentThread())
+            threadName = thread->getThreadName();
+        else if (juce::MessageManager::getInstanceWithoutCreating() != nullptr
+                  && juce::MessageManager::getInstanceWithoutCreating()->isThisTheMessageThread())
+            threadName = "Message thread";
+        else
+            threadName = "Native thread";   // e.g. the device's audio thread, which comes back on a restart
+
+        registration.buffer = &claimBuffer(threadName, tid);
+    }
+
+    return *registration.buffer;
+}
+
+PerfTrace::ThreadBuffer& PerfTrace::claimBuffer(const juce::String& threadName, juce::int64 tid)
+{
+    const juce::ScopedLock sl(registrationLock);
+
+    for (auto* buffer : buffers)
+    {
+        if (buffer->name == threadName && ! buffer->inUse.load(std::memory_order_acquire))
+        {
+            buffer->inUse.store(true, std::memory_order_relaxed);
+            return *buffer;
+        }
+    }
+
+    return *buffers.add(new ThreadBuffer(threadName, tid));
+}
+
+void PerfTrace::addZone(const char* name, juce::int64 startTicks, juce::int64 endTicks)
+{
+    if (isEnabled())
+        getBufferForThisThread().push({ name, startTicks, endTicks });
+}
+
+void PerfTrace::addInstant(const char* name)
+{
+    if (isEnabled())
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        getBufferForThisThread().push({ name, now, now });
+    }
+}
+
+void PerfTrace::markStartupPhase(const char* phase)
+{
+    const auto elapsedMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - originTicks) * 1000.0;
+    DBG("Startup: " << phase << " at " << juce::String(elapsedMs, 1) << " ms");
+    addInstant(phase);
+}
+
+bool PerfTrace::exportChromeTrace(const juce::File& outputFile)
+{
+    const auto toMicros = [this](juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks - originTicks) * 1.0e6;
+    };
+
+    juce::MemoryOutputStream json;
+    json << "{\"traceEvents\":[\n";
+    bool first = true;
+
+    const auto separator = [&json, &first]
+    {
+        if (! first)
+            json << ",\n";
+        first = false;
+    };
+
+    // Buffers are never removed, so only the list needs the lock; a thread registering
+    // mustn't wait for the JSON to be built.
+    juce::Array<ThreadBuffer*> snapshot;
+
+    {
+        const juce::ScopedLock sl(registrationLock);
+        snapshot.addArray(buffers);
+    }
+
+    for (auto* buffer : snapshot)
+    {
+        separator();
+        json << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+             << ",\"args\":{\"name\":" << juce::JSON::toString(buffer->name) << "}}";
+
+        const auto scope = buffer->fifo.read(buffer->fifo.getNumReady());
+
+        const auto writeEvents = [&](int start, int size)
+        {
+            for (int i = start; i < start + size; ++i)
+            {
+                const auto& e = buffer->events[(size_t) i];
+                separator();
+
+                if (e.endTicks == e.startTicks)
+                    json << "{\"ph\":\"i\",\"s\":\"t\"";
+                else
+                    json << "{\"ph\":\"X\",\"dur\":" << juce::String(toMicros(e.endTicks) - toMicros(e.startTicks), 3);
+
+                json << ",\"name\":\"" << e.name << "\",\"pid\":1,\"tid\":" << buffer->tid
+                     << ",\"ts\":" << juce::String(toMicros(e.startTicks), 3) << "}";
+            }
+        };
+
+        writeEvents(scope.startIndex1, scope.blockSize1);
+        writeEvents(scope.startIndex2, scope.blockSize2);
+
+        if (const auto lost = buffer->dropped.exchange(0))
+            DBG("PerfTrace: " << lost << " events dropped on " << buffer->name);
+    }
+
+    json << "\n]}\n";
+
+    return outputFile.replaceWithData(json.getData(), json.getDataSize());
+}
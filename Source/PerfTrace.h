@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    PerfTrace.h
+    Created: 19 Oct 2026 10:12:04am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Lightweight event tracer for the audio, disk and GUI threads.
+// Every thread that records a zone gets its own single-producer fifo, so
+// recording never takes a lock; the events are only gathered when the trace
+// is exported as Chrome trace JSON (open it in chrome://tracing or Perfetto).
+class PerfTrace {
+public:
+    static PerfTrace& getInstance();
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Names must be string literals (or otherwise outlive the trace).
+    void addZone(const char* name, juce::int64 startTicks, juce::int64 endTicks);
+    void addInstant(const char* name);
+
+    // Logs the time since the tracer was created (first thing in initialise) and
+    // adds an instant event, so cold-start phases show up in the timeline too.
+    void markStartupPhase(const char* phase);
+
+    // Drains every thread's events and writes them out; returns false on I/O failure.
+    bool exportChromeTrace(const juce::File& outputFile);
+
+    class ScopedZone {
+    public:
+        explicit ScopedZone(const char* zoneName) noexcept
+            : name(zoneName),
+              startTicks(PerfTrace::getInstance().isEnabled() ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedZone()
+        {
+            if (startTicks != 0)
+                PerfTrace::getInstance().addZone(name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+    private:
+        const char* name;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedZone)
+    };
+
+private:
+    PerfTrace();
+
+    struct Event {
+        const char* name;
+        juce::int64 startTicks;
+        juce::int64 endTicks;   // equal to startTicks for instant events
+    };
+
+    struct ThreadBuffer {
+        static constexpr int capacity = 1 << 15;
+
+        ThreadBuffer(juce::String threadName, juce::int64 threadId);
+        void push(const Event& e) noexcept;
+
+        juce::String name;
+        juce::int64 tid;
+        juce::AbstractFifo fifo { capacity };
+        std::vector<Event> events;
+        std::atomic<int> dropped { 0 };
+        std::atomic<bool> inUse { true };   // cleared when its thread exits
+    };
+
+    // Buffers are never freed, so a thread that exits hands its buffer on to the
+    // next thread with the same name (a render or a take starts a new one each
+    // time); they then share a row in the timeline.
+    ThreadBuffer& getBufferForThisThread();
+    ThreadBuffer& claimBuffer(const juce::String& threadName, juce::int64 tid);
+
+    std::atomic<bool> enabled { false };
+    const juce::int64 originTicks;
+
+    juce::CriticalSection registrationLock;
+    juce::OwnedArray<ThreadBuffer> buffers;
+
+    JUCE_DECLARE_NON_COPYABLE(PerfTrace)
+};
+
+#define PERF_TRACE_CONCAT_(a, b) a##b
+#define PERF_TRACE_CONCAT(a, b) PERF_TRACE_CONCAT_(a, b)
+#define PERF_TRACE_ZONE(name) PerfTrace::ScopedZone PERF_TRACE_CONCAT(perfTraceZone_, __LINE__) (name)
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    RealtimeAllocationCheck.cpp
+    Created: 19 Oct 2026 6:51:10pm
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "RealtimeAllocationCheck.h"
+
+namespace
+{
+    std::atomic<bool> prepared { false };
+    std::atomic<int> violations { 0 };
+    thread_local bool inAudioCallback = false;
+    thread_local int allowedDepth = 0;
+
+   #if AUDIO_ALLOCATION_CHECK
+    void checkAllocation() noexcept
+    {
+        if (inAudioCallback && allowedDepth == 0 && prepared.load(std::memory_order_relaxed))
+        {
+            // Only stop on the first one; the assertion itself allocates, so let it through
+            if (violations.fetch_add(1) == 0)
+            {
+                ++allowedDepth;
+                jassertfalse;   // something on the audio thread just hit the heap
+                --allowedDepth;
+            }
+        }
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment) noexcept
+    {
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, alignment);
+       #else
+        void* p = nullptr;
+        return posix_memalign(&p, juce::jmax(alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? p : nullptr;
+       #endif
+    }
+
+    void freeAligned(void* p) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+   #endif
+}
+
+void RealtimeAllocationCheck::setPrepared(bool isPreparedToPlay) noexcept
+{
+    if (isPreparedToPlay)
+        violations = 0;
+
+    prepared = isPreparedToPlay;
+}
+
+int RealtimeAllocationCheck::getNumViolations() noexcept
+{
+    return violations.load();
+}
+
+RealtimeAllocationCheck::ScopedAudioCallback::ScopedAudioCallback() noexcept     { inAudioCallback = true; }
+RealtimeAllocationCheck::ScopedAudioCallback::~ScopedAudioCallback() noexcept    { inAudioCallback = false; }
+
+RealtimeAllocationCheck::ScopedAllocationAllowed::ScopedAllocationAllowed() noexcept     { ++allowedDepth; }
+RealtimeAllocationCheck::ScopedAllocationAllowed::~ScopedAllocationAllowed() noexcept    { --allowedDepth; }
+
+#if AUDIO_ALLOCATION_CHECK
+void* operator new(std::size_t size)
+{
+    checkAllocation();
+
+    if (auto* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    checkAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept                              { std::free(p); }
+void operator delete[](void* p) noexcept                            { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept                 { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept               { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept       { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept     { std::free(p); }
+
+// Over-aligned types (alignas beyond the default) come through these instead
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    checkAllocation();
+
+    if (auto* p = allocateAligned(size, (std::size_t) alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    checkAllocation();
+    return allocateAligned(size, (std::size_t) alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept                                { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                              { freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept                   { freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept                 { freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept         { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept       { freeAligned(p); }
+#endif
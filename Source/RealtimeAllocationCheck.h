@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    RealtimeAllocationCheck.h
+    Created: 19 Oct 2026 6:51:10pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// In debug builds the global operator new (every form, aligned included) is
+// replaced with one that flags any allocation made inside getNextAudioBlock while
+// the app is prepared to play (between prepareToPlay and releaseResources). Build
+// with AUDIO_ALLOCATION_CHECK=0 to turn it off, or =1 to keep it in release builds.
+//
+// Only operator new is seen. JUCE's HeapBlock goes straight to malloc/realloc, so
+// AudioBuffer::setSize, Array growth, MemoryBlock and a ResamplingAudioSource
+// growing its buffer are NOT caught; don't take a clean run as proof of those.
+#ifndef AUDIO_ALLOCATION_CHECK
+ #define AUDIO_ALLOCATION_CHECK JUCE_DEBUG
+#endif
+
+class RealtimeAllocationCheck {
+public:
+    static void setPrepared(bool isPreparedToPlay) noexcept;
+    static int getNumViolations() noexcept;
+
+    // Put one at the top of the audio callback.
+    class ScopedAudioCallback {
+    public:
+        ScopedAudioCallback() noexcept;
+        ~ScopedAudioCallback() noexcept;
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioCallback)
+    };
+
+    // For the odd allocation on the audio thread that is known and accepted.
+    class ScopedAllocationAllowed {
+    public:
+        ScopedAllocationAllowed() noexcept;
+        ~ScopedAllocationAllowed() noexcept;
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllocationAllowed)
+    };
+};
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+    ResampledCache.cpp
+    Created: 19 Oct 2026 4:05:17pm
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "ResampledCache.h"
+#include "PerfTrace.h"
+
+ResampledCache::ResampledCache(juce::AudioFormatManager& manager)
+    : juce::Thread("Resampled cache"), formatManager(manager)
+{
+}
+
+ResampledCache::~ResampledCache()
+{
+    invalidate();
+}
+
+void ResampledCache::render(const juce::File& sourceFile, double targetSampleRate)
+{
+    invalidate();
+
+    source = sourceFile;
+    targetRate = targetSampleRate;
+    cacheFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getNonexistentChildFile(source.getFileNameWithoutExtension()
+                                                 + "_" + juce::String(juce::roundToInt(targetRate)),
+                                             ".wav");
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void ResampledCache::invalidate()
+{
+    stopThread(4000);
+    cancelPendingUpdate();
+
+    {
+        const juce::ScopedLock sl(readerLock);
+        renderedReader.reset();
+    }
+
+    ready = false;
+
+    if (cacheFile.existsAsFile())
+        cacheFile.deleteFile();
+}
+
+void ResampledCache::run()
+{
+    if (! renderToCache())
+    {
+        if (! threadShouldExit())
+            DBG("Failed to render resampled cache for " << source.getFullPathName());
+
+        cacheFile.deleteFile();
+        return;
+    }
+
+    // Map the whole cache so playback never has to touch the disk
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(wavFormat.createMemoryMappedReader(cacheFile));
+
+    if (mapped != nullptr && mapped->mapEntireFile())
+        reader = std::move(mapped);
+    else
+        reader.reset(formatManager.createReaderFor(cacheFile));  // fall back to streaming it
+
+    if (reader == nullptr)
+        return;
+
+    {
+        const juce::ScopedLock sl(readerLock);
+        renderedReader = std::move(reader);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void ResampledCache::handleAsyncUpdate()
+{
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    {
+        const juce::ScopedLock sl(readerLock);
+        reader = std::move(renderedReader);
+    }
+
+    if (reader == nullptr)
+        return;
+
+    ready = true;
+    DBG("Resampled cache ready: " << cacheFile.getFullPathName());
+
+    if (onReady != nullptr)
+        onReady(std::move(reader));
+}
+
+bool ResampledCache::renderToCache()
+{
+    PERF_TRACE_ZONE("ResampledCache::render");
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(source));
+
+    if (reader == nullptr || targetRate <= 0.0)
+        return false;
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto ratio = reader->sampleRate / targetRate;    // input samples consumed per output sample
+
+    std::unique_ptr<juce::FileOutputStream> stream = cacheFile.createOutputStream();
+
+    if (stream == nullptr)
+        return false;
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(),
+                                                                              targetRate,
+                                                                              static_cast<unsigned int>(numChannels),
+                                                                              32,  // float, so the cache adds no quantisation
+                                                                              {},
+                                                                              0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release();  // the writer owns it now
+
+    // The interpolator can read up to one sample past what the ratio implies, so always
+    // hold a couple back. Its algorithmic latency is removed from the front and flushed
+    // out of the back with silence, so the cache stays sample-aligned with the source.
+    constexpr int margin = 2;
+    const auto latency = (int) std::ceil(juce::WindowedSincInterpolator::getBaseLatency());
+    auto outputToSkip = juce::roundToInt(latency / ratio);
+
+    // The sinc kernel's cutoff sits at the source Nyquist, so when downsampling it
+    // would fold everything above the target Nyquist back down. The input goes through
+    // a linear-phase low-pass first; its delay is a whole number of input samples, so
+    // dropping that many from the front keeps the alignment exact.
+    const auto kernel = ratio > 1.0 ? makeAntiAliasingKernel(reader->sampleRate, targetRate)
+                                    : std::vector<float> { 1.0f };
+    const auto numTaps = (int) kernel.size();
+    auto inputToDrop = numTaps / 2;
+    auto zerosToFlush = numTaps / 2 + latency + margin;
+
+    // Raw input, with the last numTaps - 1 samples of the previous block in front of it
+    juce::AudioBuffer<float> raw(numChannels, numTaps - 1 + blockSize);
+    raw.clear();
+
+    juce::AudioBuffer<float> input(numChannels, blockSize + latency + 2 * margin + (int) std::ceil(ratio) + 1);
+    juce::AudioBuffer<float> output(numChannels, (int) (input.getNumSamples() / ratio) + 1);
+    std::vector<juce::WindowedSincInterpolator> interpolators((size_t) numChannels);
+
+    juce::int64 readPosition = 0;
+    int available = 0;
+
+    // Filters numSamples new raw samples onto the end of the interpolator's input
+    const auto appendFiltered = [&](int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* dest = input.getWritePointer(ch, available);
+            const auto* newest = raw.getReadPointer(ch, numTaps - 1);
+
+            juce::FloatVectorOperations::clear(dest, numSamples);
+
+            for (int tap = 0; tap < numTaps; ++tap)
+                juce::FloatVectorOperations::addWithMultiply(dest, newest - tap, kernel[(size_t) tap], numSamples);
+
+            if (numTaps > 1)
+                std::memmove(raw.getWritePointer(ch), raw.getReadPointer(ch, numSamples), sizeof(float) * (size_t) (numTaps - 1));
+        }
+
+        const auto dropped = juce::jmin(inputToDrop, numSamples);
+        inputToDrop -= dropped;
+
+        if (dropped > 0 && numSamples > dropped)
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::memmove(input.getWritePointer(ch, available), input.getReadPointer(ch, available + dropped),
+                             sizeof(float) * (size_t) (numSamples - dropped));
+
+        available += numSamples - dropped;
+    };
+
+    while (! threadShouldExit())
+    {
+        const auto toRead = (int) juce::jmin((juce::int64) blockSize, reader->lengthInSamples - readPosition);
+
+        if (toRead > 0)
+        {
+            reader->read(&raw, numTaps - 1, toRead, readPosition, true, true);
+            appendFiltered(toRead);
+            readPosition += toRead;
+        }
+        else if (zerosToFlush > 0)
+        {
+            // Silence past the end lets the low-pass ring out and flushes the interpolator
+            const auto numZeros = juce::jmin(blockSize, zerosToFlush);
+            raw.clear(numTaps - 1, numZeros);
+            appendFiltered(numZeros);
+            zerosToFlush -= numZeros;
+        }
+        else
+        {
+            break;
+        }
+
+        const auto numOutput = juce::jmax(0, (int) ((available - margin) / ratio));
+        int consumed = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            consumed = interpolators[(size_t) ch].process(ratio, input.getReadPointer(ch),
+                                                          output.getWritePointer(ch), numOutput);
+
+        const auto skipped = juce::jmin(outputToSkip, numOutput);
+        outputToSkip -= skipped;
+
+        if (numOutput > skipped && ! writer->writeFromAudioSampleBuffer(output, skipped, numOutput - skipped))
+            return false;
+
+        available -= consumed;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::memmove(input.getWritePointer(ch), input.getReadPointer(ch, consumed), sizeof(float) * (size_t) available);
+    }
+
+    if (threadShouldExit())
+        return false;
+
+    writer.reset();  // flushes the header before the file gets mapped
+    return true;
+}
+
+std::vector<float> ResampledCache::makeAntiAliasingKernel(double sourceRate, double targetRate)
+{
+    // Kaiser-windowed sinc: flat to 0.45 x the target rate and at least
+    // attenuationDb down from the target Nyquist up (Kaiser's length and beta estimates)
+    constexpr double attenuationDb = 90.0;
+    const auto passEdge = 0.45 * targetRate / sourceRate;     // in cycles per source sample
+    const auto stopEdge = 0.5 * targetRate / sourceRate;
+    const auto cutoff = 0.5 * (passEdge + stopEdge);
+    const auto beta = 0.1102 * (attenuationDb - 8.7);
+
+    auto numTaps = (int) std::ceil((attenuationDb - 7.95)
+                                   / (2.285 * juce::MathConstants<double>::twoPi * (stopEdge - passEdge))) + 1;
+    numTaps |= 1;   // odd, so the delay is a whole number of samples
+    const auto centre = numTaps / 2;
+
+    const auto besselI0 = [](double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; term > 1.0e-12 * sum; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    };
+
+    std::vector<double> taps((size_t) numTaps);
+    double sum = 0.0;
+
+    for (int i = 0; i < numTaps; ++i)
+    {
+        const auto n = i - centre;
+        const auto sinc = n == 0 ? 2.0 * cutoff
+                                 : std::sin(juce::MathConstants<double>::twoPi * cutoff * n) / (juce::MathConstants<double>::pi * n);
+        const auto r = (double) n / centre;
+
+        taps[(size_t) i] = sinc * besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+        sum += taps[(size_t) i];
+    }
+
+    std::vector<float> kernel((size_t) numTaps);
+
+    for (int i = 0; i < numTaps; ++i)
+        kernel[(size_t) i] = (float) (taps[(size_t) i] / sum);   // unity gain at DC
+
+    return kernel;
+}
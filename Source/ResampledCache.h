@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    ResampledCache.h
+    Created: 19 Oct 2026 4:05:17pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Renders a file to the device sample rate on a background thread with a
+// windowed-sinc resampler (behind a linear-phase low-pass at the target Nyquist
+// when downsampling), into a temporary float WAV. When the render has
+// finished, onReady is called on the message thread with a memory-mapped reader
+// for the cache, which can be played back without any real-time conversion.
+class ResampledCache : private juce::Thread,
+                       private juce::AsyncUpdater {
+public:
+    explicit ResampledCache(juce::AudioFormatManager& formatManager);
+    ~ResampledCache() override;
+
+    // Cancels any render in progress and starts a new one.
+    void render(const juce::File& sourceFile, double targetSampleRate);
+
+    // Stops rendering and deletes the cache file, e.g. when the device rate changes.
+    void invalidate();
+
+    bool isReady() const noexcept { return ready; }
+    double getSampleRate() const noexcept { return targetRate; }
+
+    std::function<void(std::unique_ptr<juce::AudioFormatReader>)> onReady;
+
+private:
+    void run() override;
+    void handleAsyncUpdate() override;
+    bool renderToCache();
+    static std::vector<float> makeAntiAliasingKernel(double sourceRate, double targetRate);
+
+    static constexpr int blockSize = 8192;
+
+    juce::AudioFormatManager& formatManager;
+    juce::File source, cacheFile;
+    double targetRate = 0.0;
+    bool ready = false;
+
+    juce::CriticalSection readerLock;
+    std::unique_ptr<juce::AudioFormatReader> renderedReader;
+};
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    SegmentedDecoder.cpp
+    Created: 19 Oct 2026 2:40:31pm
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "SegmentedDecoder.h"
+#include "PerfTrace.h"
+
+SegmentedDecoder::SegmentedDecoder(juce::AudioFormatManager& manager, int numWorkers)
+    : formatManager(manager), pool(juce::jmax(1, numWorkers))
+{
+}
+
+bool SegmentedDecoder::decode(const juce::File& file, Result& result)
+{
+    PERF_TRACE_ZONE("SegmentedDecoder::decode");
+
+    std::unique_ptr<juce::AudioFormatReader> probe(formatManager.createReaderFor(file));
+
+    if (probe == nullptr || probe->lengthInSamples <= 0)
+        return false;
+
+    const auto length = probe->lengthInSamples;
+    const auto numChannels = (int) probe->numChannels;
+    const auto numSegments = (int) juce::jlimit((juce::int64) 1,
+                                                (juce::int64) pool.getNumThreads(),
+                                                length / minSamplesPerSegment);
+
+    result.samples.setSize(numChannels, (int) length, false, false, true);
+    result.sampleRate = probe->sampleRate;
+
+    // Taken once here so the workers never touch the AudioBuffer object itself
+    auto* const* destChannels = result.samples.getArrayOfWritePointers();
+
+    std::vector<SegmentStats> stats((size_t) numSegments);
+    std::atomic<int> remaining { numSegments };
+    juce::WaitableEvent finished;
+
+    for (int segment = 0; segment < numSegments; ++segment)
+    {
+        const auto start = length * segment / numSegments;
+        const auto end = length * (segment + 1) / numSegments;
+
+        auto decodeSegment = [&, segment, start, end]
+        {
+            PERF_TRACE_ZONE("SegmentedDecoder::segment");
+            auto& segmentStats = stats[(size_t) segment];
+            const auto numSamples = (int) (end - start);
+
+            // Segment 0 reuses the probe reader; the others each need their own stream
+            std::unique_ptr<juce::AudioFormatReader> ownReader;
+            auto* reader = probe.get();
+
+            if (segment != 0)
+            {
+                ownReader.reset(formatManager.createReaderFor(file));
+                reader = ownReader.get();
+            }
+
+            if (reader != nullptr)
+            {
+                std::vector<float*> segmentChannels;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    segmentChannels.push_back(destChannels[ch] + start);
+
+                segmentStats.ok = reader->read(segmentChannels.data(), numChannels, start, numSamples);
+
+                if (segmentStats.ok)
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                    {
+                        const auto* data = segmentChannels[(size_t) ch];
+                        const auto channelRange = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+
+                        // Seed from the first channel, a default Range would drag 0 into every segment
+                        segmentStats.range = ch == 0 ? channelRange : segmentStats.range.getUnionWith(channelRange);
+
+                        for (int i = 0; i < numSamples; ++i)
+                            segmentStats.sumOfSquares += (double) data[i] * data[i];
+                    }
+                }
+            }
+
+            if (--remaining == 0)
+                finished.signal();
+        };
+
+        pool.addJob(decodeSegment);
+    }
+
+    finished.wait();
+
+    result.segmentPeaks.clearQuick();
+    result.peak = 0.0f;
+    double sumOfSquares = 0.0;
+
+    for (const auto& segmentStats : stats)
+    {
+        if (! segmentStats.ok)
+            return false;
+
+        result.segmentPeaks.add(segmentStats.range);
+        result.peak = juce::jmax(result.peak,
+                                 std::abs(segmentStats.range.getStart()),
+                                 std::abs(segmentStats.range.getEnd()));
+        sumOfSquares += segmentStats.sumOfSquares;
+    }
+
+    result.rms = (float) std::sqrt(sumOfSquares / ((double) length * juce::jmax(1, numChannels)));
+    return true;
+}
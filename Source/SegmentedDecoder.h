@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    SegmentedDecoder.h
+    Created: 19 Oct 2026 2:40:31pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Decodes a whole file by splitting it into contiguous segments, each read by its
+// own AudioFormatReader on a worker thread. Segments land in disjoint regions of
+// the output buffer, and the per-segment statistics are merged in file order.
+class SegmentedDecoder {
+public:
+    struct Result {
+        juce::AudioBuffer<float> samples;
+        double sampleRate = 0.0;
+        float peak = 0.0f;      // absolute peak over all channels
+        float rms = 0.0f;       // rms over all channels
+        juce::Array<juce::Range<float>> segmentPeaks;   // min/max per segment, in file order
+    };
+
+    explicit SegmentedDecoder(juce::AudioFormatManager& formatManager,
+                              int numWorkers = juce::SystemStats::getNumCpus());
+
+    // Blocks until every segment has been decoded; returns false if the file can't be read.
+    bool decode(const juce::File& file, Result& result);
+
+private:
+    struct SegmentStats {
+        juce::Range<float> range;
+        double sumOfSquares = 0.0;
+        bool ok = false;
+    };
+
+    // Below this length a single reader is quicker than the thread hand-off.
+    static constexpr juce::int64 minSamplesPerSegment = 1 << 18;
+
+    juce::AudioFormatManager& formatManager;
+    juce::ThreadPool pool;
+};